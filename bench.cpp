@@ -0,0 +1,154 @@
+/**
+ * @file   bench.cpp
+ * @author GZ <gaelxarco@icloud.com>
+ * @brief  Per-phase benchmark harness over synthetic PPM frames
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <print>
+#include <span>
+#include <spanstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+import ppm;
+
+// -----------------------------------------------------------------------------
+// FRAME GENERATOR(S)
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief  Serializes a synthetic P6 frame with a deterministic ramp
+ *         pattern
+ * @param  w   Width
+ * @param  h   Height
+ * @param  max Max color value
+ * @return serialized frame bytes
+ */
+std::string make_p6(PPM::size_type w, PPM::size_type h, PPM::size_type max) {
+    /// Total per-pixel RGB color values
+    const PPM::size_type samples = w * h * 3;
+    std::string out;                /// Serialized frame
+    out += "P6\n" + std::to_string(w) + ' ' + std::to_string(h) + '\n' +
+        std::to_string(max) + '\n';
+
+    for (PPM::size_type i{}; i < samples; ++i) {
+        const PPM::size_type v = i % (max + 1);     /// Current sample
+
+        if (max > 255) {
+            out += static_cast<char>((v >> 8) & 0xFF);
+        }
+        out += static_cast<char>(v & 0xFF);
+    }
+
+    return out;
+}           // make_p6
+
+/**
+ * @brief  Serializes a synthetic P3 frame with a deterministic ramp
+ *         pattern
+ * @param  w   Width
+ * @param  h   Height
+ * @param  max Max color value
+ * @return serialized frame bytes
+ */
+std::string make_p3(PPM::size_type w, PPM::size_type h, PPM::size_type max) {
+    /// Total per-pixel RGB color values
+    const PPM::size_type samples = w * h * 3;
+    std::string out;                /// Serialized frame
+    out += "P3\n" + std::to_string(w) + ' ' + std::to_string(h) + '\n' +
+        std::to_string(max) + '\n';
+
+    for (PPM::size_type i{}; i < samples; ++i) {
+        out += std::to_string(i % (max + 1));
+        out += (i % 12 == 11) ? '\n' : ' ';
+    }
+
+    return out;
+}           // make_p3
+
+// -----------------------------------------------------------------------------
+// TIMER(S)
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief  Runs fn for the given rep count and reports throughput
+ * @param  label   Phase label to print
+ * @param  bytes   Bytes moved per rep
+ * @param  samples Samples touched per rep
+ * @param  reps    Repetition count
+ * @param  fn      Phase under test
+ */
+template <class Fn>
+void time_phase(const std::string& label, PPM::size_type bytes,
+PPM::size_type samples, PPM::size_type reps, Fn fn) {
+    const auto start = std::chrono::steady_clock::now();    /// Phase start
+
+    for (PPM::size_type r{}; r < reps; ++r) { fn(); }
+
+    /// Elapsed wall time in seconds
+    const double secs = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    const double mbs = static_cast<double>(bytes) * reps / secs / 1e6;
+    const double sps = static_cast<double>(samples) * reps / secs / 1e6;
+
+    std::println("{}: {:.1f} MB/s {:.1f} Msamples/s", label, mbs, sps);
+}           // time_phase
+
+// -----------------------------------------------------------------------------
+// MAIN
+// -----------------------------------------------------------------------------
+
+int main() {
+    /// Frame size sweep, small thumbnails through full 1080p
+    constexpr std::pair<PPM::size_type, PPM::size_type> sizes[]{
+        {64, 64}, {256, 256}, {512, 512}, {1024, 1024}, {1920, 1080}
+    };
+    /// Color depth sweep, 8- and 16-bit
+    constexpr PPM::size_type depths[]{255, 65'535};
+
+    for (const auto& [w, h] : sizes) {
+        for (const auto max : depths) {
+            for (const bool binary : {true, false}) {
+                /// Serialized synthetic frame
+                const std::string frame = binary
+                    ? make_p6(w, h, max) : make_p3(w, h, max);
+                /// Total per-pixel RGB color values
+                const PPM::size_type samples = w * h * 3;
+                /// Reps scaled so each phase moves ~64MB
+                const PPM::size_type reps =
+                    std::max<PPM::size_type>(1, (1 << 26) / frame.size());
+                /// Case label shared by the three phase lines
+                const std::string tag = std::string(binary ? "P6" : "P3") +
+                    (max > 255 ? " 16-bit " : "  8-bit ") +
+                    std::to_string(w) + 'x' + std::to_string(h);
+
+                PPM img{};          /// Image reused across phases and reps
+
+                time_phase(tag + " parse ", frame.size(), samples, reps,
+                    [&] {
+                        std::ispanstream is(std::span<const char>{
+                            frame.data(), frame.size()
+                        });
+                        (void)read_ppm(is, img);
+                    });
+
+                time_phase(tag + " invert", samples * (max > 255 ? 2 : 1),
+                    samples, reps, [&] { img.invert(); });
+
+                std::ostringstream os;      /// Sink for the emit phase
+                time_phase(tag + " emit  ", frame.size(), samples, reps,
+                    [&] {
+                        os.str({});
+                        img.out_ppm(os);
+                    });
+            }
+        }
+    }
+
+    return 0;
+}           // main
+
+// EOF bench.cpp
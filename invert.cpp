@@ -4,28 +4,748 @@
  * @brief  Inverts colors from .ppm images
  */
 
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <optional>
 #include <print>
-#include <expected>
+#include <span>
+#include <spanstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 import ppm;
 
 // -----------------------------------------------------------------------------
-// MAIN
+// OP CHAIN
+// -----------------------------------------------------------------------------
+
+/// @brief Runtime descriptor for one --op entry
+struct OpSpec {
+    /// @brief Supported per-pixel operations
+    enum class Kind { Invert, Brightness, Gamma, Swap };
+
+    Kind kind;          /// Which operation
+    double arg;         /// Brightness delta or gamma exponent
+    int a, b;           /// Channel indices for Swap
+};          // OpSpec
+
+/**
+ * @brief  Parses a comma-separated op chain such as
+ *         "invert,brightness=30,gamma=2.2,swap=rb"
+ * @param  s   Chain argument text
+ * @param  out Parsed chain, appended in order
+ * @return true on success, false on malformed input
+ */
+bool parse_ops(const char* s, std::vector<OpSpec>& out) {
+    std::string_view rest{s};           /// Unparsed chain tail
+
+    /// Maps a channel letter to its index, -1 if invalid
+    auto channel = [](char c) {
+        return c == 'r' ? 0 : c == 'g' ? 1 : c == 'b' ? 2 : -1;
+    };
+
+    while (!rest.empty()) {
+        const std::size_t comma = rest.find(',');   /// Next separator
+        std::string_view tok = rest.substr(0, comma);   /// Current op text
+        rest = comma == std::string_view::npos
+            ? std::string_view{} : rest.substr(comma + 1);
+
+        if (tok == "invert") {
+            out.push_back({OpSpec::Kind::Invert, 0.0, 0, 0});
+        } else if (tok.starts_with("brightness=")) {
+            tok.remove_prefix(11);
+            double delta{};             /// Parsed channel shift
+            auto [p, ec] = std::from_chars(tok.begin(), tok.end(), delta);
+            if (ec != std::errc{} || p != tok.end()) { return false; }
+            out.push_back({OpSpec::Kind::Brightness, delta, 0, 0});
+        } else if (tok.starts_with("gamma=")) {
+            tok.remove_prefix(6);
+            double gamma{};             /// Parsed gamma exponent
+            auto [p, ec] = std::from_chars(tok.begin(), tok.end(), gamma);
+            if (ec != std::errc{} || p != tok.end() || gamma <= 0.0) {
+                return false;
+            }
+            out.push_back({OpSpec::Kind::Gamma, gamma, 0, 0});
+        } else if (tok == "swap") {
+            out.push_back({OpSpec::Kind::Swap, 0.0, 0, 2});
+        } else if (tok.starts_with("swap=") && tok.size() == 7) {
+            const int a = channel(tok[5]);      /// First swapped channel
+            const int b = channel(tok[6]);      /// Second swapped channel
+            if (a < 0 || b < 0) { return false; }
+            out.push_back({OpSpec::Kind::Swap, 0.0, a, b});
+        } else {
+            return false;
+        }
+    }
+
+    return !out.empty();
+}           // parse_ops
+
+/**
+ * @brief Runs the selected op chain (or plain invert when empty) over
+ *        an image in a single fused pass
+ * @param img     Parsed image
+ * @param ops     Op chain in application order
+ * @param threads Worker threads for the plain invert path
+ * @param lut     Invert through the cached lookup table
+ */
+void run_ops(PPM& img, const std::vector<OpSpec>& ops,
+PPM::size_type threads, bool lut = false) {
+    if (ops.empty()) {
+        lut ? img.invert_lut(threads) : img.invert(threads);
+        return;
+    }
+
+    const PPM::size_type max = img.get_max();   /// Max color value
+
+    if (ops.size() == 1) {
+        // Single ops dispatch to a fused compile-time instantiation
+        switch (ops[0].kind) {
+            case OpSpec::Kind::Invert:
+                lut ? img.invert_lut(threads) : img.invert(threads);
+                return;
+            case OpSpec::Kind::Brightness:
+                img.apply(BrightnessOp{static_cast<long>(ops[0].arg), max});
+                return;
+            case OpSpec::Kind::Gamma:
+                img.apply(GammaOp{ops[0].arg, max});
+                return;
+            case OpSpec::Kind::Swap:
+                img.apply(SwapOp{ops[0].a, ops[0].b});
+                return;
+        }
+    }
+
+    // Longer chains stay one pass over the data, dispatching per op
+    img.apply([&](PPM::Pixel& p) {
+        for (const OpSpec& op : ops) {
+            switch (op.kind) {
+                case OpSpec::Kind::Invert:
+                    InvertOp{max}(p);
+                    break;
+                case OpSpec::Kind::Brightness:
+                    BrightnessOp{static_cast<long>(op.arg), max}(p);
+                    break;
+                case OpSpec::Kind::Gamma:
+                    GammaOp{op.arg, max}(p);
+                    break;
+                case OpSpec::Kind::Swap:
+                    SwapOp{op.a, op.b}(p);
+                    break;
+            }
+        }
+    });
+}           // run_ops
+
 // -----------------------------------------------------------------------------
+// STATS
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Emits the machine-readable stats line to stderr on scope exit
+ *        when instrumentation is enabled
+ */
+struct StatsReporter {
+    ~StatsReporter() {
+        if (!PPM::stats_enabled()) { return; }
+
+        const PPM::Stats& s = PPM::stats();     /// Accumulated counters
+        std::println(std::cerr,
+            "stats frames={} parse_s={} invert_s={} emit_s={} "
+            "bytes_in={} bytes_out={} allocs={} crc32c={:08x}",
+            s.frames, s.parse_s, s.invert_s, s.emit_s,
+            s.bytes_in, s.bytes_out, s.allocs, s.crc32c);
+    }           // destructor
+};          // StatsReporter
+
+// -----------------------------------------------------------------------------
+// FILE MODE
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief  Inverts in_path into out_path through memory-mapped I/O: P6
+ *         images go straight from the input map to a pre-sized output
+ *         map, other inputs fall back to the stream parser over the map
+ * @param  in_path  Source PPM path
+ * @param  out_path Destination PPM path
+ * @param  threads  Worker threads for the fallback invert
+ * @return 0 on success, 1 on failure
+ */
+int invert_file(const char* in_path, const char* out_path,
+PPM::size_type threads) {
+    const int in_fd = open(in_path, O_RDONLY);      /// Source descriptor
+
+    if (in_fd < 0) {
+        std::println("[ERR] Cannot open {}", in_path);
+        return 1;
+    }
+
+    struct stat st{};               /// Source file metadata
+
+    if (fstat(in_fd, &st) < 0 || st.st_size <= 0) {
+        std::println("[ERR] Cannot stat {}", in_path);
+        close(in_fd);
+        return 1;
+    }
+
+    const std::size_t in_size = static_cast<std::size_t>(st.st_size);
+    /// Read-only map over the whole source image
+    void* in_map = mmap(nullptr, in_size, PROT_READ, MAP_PRIVATE, in_fd, 0);
+    close(in_fd);
+
+    if (in_map == MAP_FAILED) {
+        std::println("[ERR] Cannot mmap {}", in_path);
+        return 1;
+    }
+
+    const std::uint8_t* in_bytes = static_cast<const std::uint8_t*>(in_map);
 
-int main() {
+    if (in_size >= 2 && in_bytes[0] == 'P' && in_bytes[1] == '6') {
+        // Zero-copy path: map the output at source size, transform into
+        // it, then trim to the bytes actually written
+        const int out_fd = open(out_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+        if (out_fd < 0 || ftruncate(out_fd, st.st_size) < 0) {
+            std::println("[ERR] Cannot create {}", out_path);
+            if (out_fd >= 0) { close(out_fd); }
+            munmap(in_map, in_size);
+            return 1;
+        }
+
+        /// Writable map over the pre-sized destination
+        void* out_map = mmap(nullptr, in_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED, out_fd, 0);
+
+        if (out_map == MAP_FAILED) {
+            std::println("[ERR] Cannot mmap {}", out_path);
+            close(out_fd);
+            munmap(in_map, in_size);
+            return 1;
+        }
+
+        /// Bytes written into the output map, or PPM::Error
+        std::expected<PPM::size_type, PPM::Error> written = invert_mapped(
+            {in_bytes, in_size},
+            {static_cast<std::uint8_t*>(out_map), in_size});
+
+        munmap(out_map, in_size);
+        munmap(in_map, in_size);
+
+        if (!written) {
+            std::println("[ERR] {}", written.error().msg);
+            close(out_fd);
+            return 1;
+        }
+
+        if (ftruncate(out_fd, static_cast<off_t>(*written)) < 0) {
+            std::println("[ERR] Cannot resize {}", out_path);
+            close(out_fd);
+            return 1;
+        }
+
+        close(out_fd);
+        return 0;
+    }
+
+    /// Stream view over the mapped source for the P3 fallback
+    std::ispanstream is(std::span<const char>{
+        static_cast<const char*>(in_map), in_size
+    });
     /// PPM image
-    std::expected<PPM, PPM::Error> ppm = read_ppm(std::cin);
+    std::expected<PPM, PPM::Error> ppm = read_ppm(is);
+    munmap(in_map, in_size);
 
     if (!ppm) {
         std::println("[ERR] {}", ppm.error().msg);
         return 1;
     }
 
-    PPM& img = *ppm;          /// Validated PPM image
-    img.invert();
-    img.out_ppm(std::cout);
+    std::ofstream os(out_path, std::ios::binary);   /// Destination stream
+
+    if (!os) {
+        std::println("[ERR] Cannot create {}", out_path);
+        return 1;
+    }
+
+    ppm->invert(threads);
+    ppm->out_ppm(os);
+    return os ? 0 : 1;
+}           // invert_file
+
+// -----------------------------------------------------------------------------
+// DIRECTORY MODE
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief  Walks a directory tree, queues every .ppm file, and inverts
+ *         them on N worker threads, each owning a reusable PPM so no
+ *         per-file buffer allocation happens in steady state. Results
+ *         are written next to each source as <name>.inv.ppm; workers
+ *         pull files from a shared atomic queue index so load balances
+ *         dynamically. Prints a files/s summary to stderr.
+ * @param  dir     Directory to walk recursively
+ * @param  threads Worker thread count
+ * @param  ops     Transform chain (plain invert when empty)
+ * @param  lut     Invert through the cached lookup table
+ * @param  to      Target wire format when transcoding on output
+ * @return 0 on success, 1 if any file failed
+ */
+int invert_dir(const char* dir, PPM::size_type threads,
+const std::vector<OpSpec>& ops, bool lut = false,
+std::optional<PPM::MagicNum> to = {}) {
+    namespace fs = std::filesystem;
+    std::vector<fs::path> files;        /// Work queue, filled up front
+
+    std::error_code ec;                 /// Walk error, reported not thrown
+    for (const auto& entry : fs::recursive_directory_iterator(dir, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".ppm" &&
+            !entry.path().stem().string().ends_with(".inv")) {
+            files.push_back(entry.path());
+        }
+    }
+
+    if (ec) {
+        std::println("[ERR] Cannot walk {}: {}", dir, ec.message());
+        return 1;
+    }
+
+    if (threads == 0 || threads > files.size()) {
+        threads = std::max<PPM::size_type>(1, files.size());
+    }
+
+    // The stats counters are a single shared block with no locking, so
+    // concurrent workers would tear them; one worker tallies correctly
+    if (PPM::stats_enabled() && threads > 1) {
+        std::println("[ERR] --stats requires --threads 1 with --dir");
+        return 1;
+    }
+
+    std::atomic<std::size_t> next{0};       /// Shared queue cursor
+    std::atomic<std::size_t> failed{0};     /// Files that failed
+    std::mutex err_mutex;                   /// Serializes error prints
+    const auto start = std::chrono::steady_clock::now();    /// Job start
+
+    /// Worker loop: claim the next file, invert it, write the sibling
+    auto worker = [&] {
+        PPM img{};                      /// Image reused across files
+
+        for (std::size_t i; (i = next.fetch_add(1)) < files.size();) {
+            const fs::path& in = files[i];      /// Current source
+            /// Destination path, <name>.inv.ppm beside the source
+            fs::path out = in;
+            out.replace_extension(".inv.ppm");
+
+            std::ifstream is(in, std::ios::binary);     /// Source stream
+
+            /// Parse result for the current file
+            std::expected<void, PPM::Error> res = is
+                ? read_ppm(is, img)
+                : std::unexpected(PPM::Error{"Cannot open file"});
+
+            if (res) {
+                run_ops(img, ops, 1, lut);
+                std::ofstream os(out, std::ios::binary);    /// Sink
+                to ? img.out_ppm(os, *to) : img.out_ppm(os);
+                if (os) { continue; }
+                res = std::unexpected(PPM::Error{"Cannot write file"});
+            }
+
+            failed.fetch_add(1);
+            const std::lock_guard lock(err_mutex);
+            std::println(std::cerr, "[ERR] {}: {}", in.string(),
+                res.error().msg);
+        }
+    };
+
+    std::vector<std::thread> pool;      /// Worker threads
+    pool.reserve(threads);
+    for (PPM::size_type t{}; t < threads; ++t) { pool.emplace_back(worker); }
+    for (auto& w : pool) { w.join(); }
+
+    /// Elapsed wall time in seconds
+    const double secs = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    std::println(std::cerr, "dir files={} failed={} threads={} secs={} "
+        "files_per_s={}", files.size(), failed.load(), threads, secs,
+        secs > 0.0 ? static_cast<double>(files.size()) / secs : 0.0);
+
+    return failed.load() == 0 ? 0 : 1;
+}           // invert_dir
+
+// -----------------------------------------------------------------------------
+// SERVER MODE
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief  Long-lived invert service on a Unix domain socket, so callers
+ *         skip the per-request fork+exec+link cost. One connection
+ *         carries one frame: the client sends a PPM payload and shuts
+ *         down its write half, the server responds with the inverted
+ *         frame (or an [ERR] line) and closes. The parsed image and
+ *         request/response buffers are reused across requests, so
+ *         steady state allocates nothing.
+ * @param  sock_path Socket path; any stale file there is replaced
+ * @param  threads   Worker threads for the invert pass
+ * @return 1 on socket setup failure, otherwise loops until killed
+ */
+int serve(const char* sock_path, PPM::size_type threads) {
+    /// Listening socket descriptor
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd < 0) {
+        std::println("[ERR] Cannot create socket");
+        return 1;
+    }
+
+    sockaddr_un addr{};             /// Bind address
+    addr.sun_family = AF_UNIX;
+
+    if (std::strlen(sock_path) >= sizeof(addr.sun_path)) {
+        std::println("[ERR] Socket path too long: {}", sock_path);
+        close(fd);
+        return 1;
+    }
+    std::strcpy(addr.sun_path, sock_path);
+
+    unlink(sock_path);
+
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&addr),
+        sizeof(addr)) < 0 || listen(fd, 64) < 0) {
+        std::println("[ERR] Cannot bind {}", sock_path);
+        close(fd);
+        return 1;
+    }
+
+    // A client that disconnects mid-response raises SIGPIPE on the next
+    // write, which would kill the whole server; the write's EPIPE error
+    // is handled instead
+    signal(SIGPIPE, SIG_IGN);
+
+    std::println(std::cerr, "serving on {}", sock_path);
+
+    PPM img{};                      /// Image reused across requests
+    std::vector<char> req;          /// Request bytes, capacity reused
+    std::ostringstream res;         /// Response bytes, reused
+
+    for (;;) {
+        const int cfd = accept(fd, nullptr, nullptr);   /// Request socket
+
+        if (cfd < 0) { continue; }
+
+        // Read-until-EOF framing: the client half-closes after sending
+        req.clear();
+        for (;;) {
+            const std::size_t used = req.size();    /// Bytes so far
+            req.resize(used + 65'536);
+
+            const ssize_t n = read(cfd, req.data() + used, 65'536);
+
+            if (n < 0 && errno == EINTR) {
+                req.resize(used);
+                continue;
+            }
+            if (n <= 0) {
+                req.resize(used);
+                break;
+            }
+            req.resize(used + static_cast<std::size_t>(n));
+        }
+
+        /// Stream view over the request for in-place parsing
+        std::ispanstream is(std::span<const char>{req.data(), req.size()});
+        /// Parse result for the current request
+        std::expected<void, PPM::Error> r = read_ppm(is, img);
+
+        res.str({});
+
+        if (r) {
+            img.invert(threads);
+            img.out_ppm(res);
+        } else {
+            res << "[ERR] " << r.error().msg << '\n';
+        }
+
+        /// Serialized response (string lives until the writes finish)
+        const std::string body = res.str();
+
+        for (std::size_t off{}; off < body.size();) {
+            const ssize_t n = write(cfd, body.data() + off,
+                body.size() - off);
+
+            if (n < 0 && errno == EINTR) { continue; }
+            if (n <= 0) { break; }
+            off += static_cast<std::size_t>(n);
+        }
+
+        close(cfd);
+    }
+}           // serve
+
+// -----------------------------------------------------------------------------
+// MAIN
+// -----------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+    PPM::size_type threads = 1;         /// Worker threads for invert
+    bool stream = false;                /// Scanline streaming mode
+    bool batch = false;                 /// Concatenated-stdin batch mode
+    bool lut = false;                   /// Invert via cached lookup table
+    bool delta = false;                 /// Frame-differential batch mode
+    std::optional<std::uint32_t> verify;/// Expected sidecar CRC32C
+    std::optional<PPM::MagicNum> to;    /// Output transcode target
+    const char* in_path = nullptr;      /// File-mode source path
+    const char* out_path = nullptr;     /// File-mode destination path
+    const char* dir_path = nullptr;     /// Directory-mode root path
+    const char* sock_path = nullptr;    /// Server-mode socket path
+    std::vector<const char*> inputs;    /// Positional batch input files
+    std::vector<OpSpec> ops;            /// Transform chain from --op
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--stream") == 0) {
+            stream = true;
+        } else if (std::strcmp(argv[i], "--stats") == 0) {
+            PPM::enable_stats(true);
+        } else if (std::strcmp(argv[i], "--trusted") == 0) {
+            PPM::set_trusted(true);
+        } else if (std::strcmp(argv[i], "--crc") == 0) {
+            PPM::enable_checksum(true);
+        } else if (std::strcmp(argv[i], "--verify") == 0 && i + 1 < argc) {
+            const char* arg = argv[++i];        /// Sidecar CRC32C text
+            std::uint32_t want{};               /// Parsed expected value
+            auto [p, ec] = std::from_chars(arg, arg + std::strlen(arg),
+                want, 16);
+
+            if (ec != std::errc{} || *p != '\0') {
+                std::println("[ERR] Invalid --verify value: {}", arg);
+                return 1;
+            }
+
+            verify = want;
+            PPM::enable_checksum(true);
+        } else if (std::strcmp(argv[i], "--batch") == 0) {
+            batch = true;
+        } else if (std::strcmp(argv[i], "--lut") == 0) {
+            lut = true;
+        } else if (std::strcmp(argv[i], "--delta") == 0) {
+            delta = true;
+        } else if (std::strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            const char* arg = argv[++i];        /// Target format text
+
+            if (std::strcmp(arg, "p6") == 0) {
+                to = PPM::MagicNum::P6;
+            } else if (std::strcmp(arg, "p3") == 0) {
+                to = PPM::MagicNum::P3;
+            } else {
+                std::println("[ERR] Invalid --to value: {}", arg);
+                return 1;
+            }
+        } else if (argv[i][0] != '-') {
+            inputs.push_back(argv[i]);
+        } else if (std::strcmp(argv[i], "--op") == 0 && i + 1 < argc) {
+            if (!parse_ops(argv[++i], ops)) {
+                std::println("[ERR] Invalid --op chain: {}", argv[i]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--in") == 0 && i + 1 < argc) {
+            in_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--dir") == 0 && i + 1 < argc) {
+            dir_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            sock_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--max-dims") == 0 && i + 1 < argc) {
+            const char* arg = argv[++i];        /// WxH limit text
+            PPM::size_type w{};                 /// Parsed width limit
+            PPM::size_type h{};                 /// Parsed height limit
+            auto [p, ec] = std::from_chars(arg, arg + std::strlen(arg), w);
+
+            if (ec == std::errc{} && *p == 'x') {
+                auto [q, ec2] = std::from_chars(p + 1,
+                    arg + std::strlen(arg), h);
+                if (ec2 == std::errc{} && *q == '\0' && w > 0 && h > 0) {
+                    PPM::set_limits(w, h);
+                    continue;
+                }
+            }
+
+            std::println("[ERR] Invalid --max-dims value: {}", arg);
+            return 1;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            const char* arg = argv[++i];
+            auto [p, ec] = std::from_chars(arg, arg + std::strlen(arg),
+                threads);
+            if (ec != std::errc{} || threads == 0) {
+                std::println("[ERR] Invalid --threads value: {}", arg);
+                return 1;
+            }
+        } else {
+            std::println("[ERR] Unknown argument: {}", argv[i]);
+            return 1;
+        }
+    }
+
+    StatsReporter reporter{};           /// Prints stats on every exit path
+
+    if ((in_path != nullptr) != (out_path != nullptr)) {
+        std::println("[ERR] --in and --out must be given together");
+        return 1;
+    }
+
+    if (!ops.empty() && (in_path != nullptr || stream)) {
+        std::println("[ERR] --op is not supported with --in/--out or --stream");
+        return 1;
+    }
+
+    if (lut && (in_path != nullptr || stream)) {
+        std::println("[ERR] --lut is not supported with --in/--out or --stream");
+        return 1;
+    }
+
+    if (to && (in_path != nullptr || stream)) {
+        std::println("[ERR] --to is not supported with --in/--out or --stream");
+        return 1;
+    }
+
+    if (delta && (!batch || !ops.empty() || lut || to)) {
+        std::println("[ERR] --delta requires --batch with plain inversion");
+        return 1;
+    }
+
+    if (verify && (in_path != nullptr || dir_path != nullptr || stream)) {
+        std::println(
+            "[ERR] --verify is not supported with --in/--out, --dir, or "
+            "--stream");
+        return 1;
+    }
+
+    /// Compares the fused parse checksum against the sidecar value
+    auto crc_ok = [&](void) {
+        if (!verify || PPM::stats().crc32c == *verify) { return true; }
+
+        std::println("[ERR] Checksum mismatch: got {:08x}, want {:08x}",
+            PPM::stats().crc32c, static_cast<std::size_t>(*verify));
+        return false;
+    };
+
+    if (sock_path != nullptr) { return serve(sock_path, threads); }
+
+    if (in_path != nullptr) { return invert_file(in_path, out_path, threads); }
+
+    if (dir_path != nullptr) { return invert_dir(dir_path, threads, ops, lut, to); }
+
+    if (!inputs.empty()) {
+        PPM img{};                  /// Image reused across every file
+
+        for (const char* path : inputs) {
+            std::ifstream is(path, std::ios::binary);   /// Current input
+
+            if (!is) {
+                std::println("[ERR] Cannot open {}", path);
+                return 1;
+            }
+
+            /// Parse result for the current file
+            std::expected<void, PPM::Error> res = read_ppm(is, img);
+
+            if (!res) {
+                std::println("[ERR] {}: {}", path, res.error().msg);
+                return 1;
+            }
+
+            if (!crc_ok()) { return 1; }
+
+            run_ops(img, ops, threads, lut);
+            to ? img.out_ppm(std::cout, *to) : img.out_ppm(std::cout);
+        }
+
+        return 0;
+    }
+
+    if (batch) {
+        PPM img{};                  /// Image reused across every frame
+        FrameCache cache{};         /// Differential state for --delta
+
+        while (std::cin >> std::ws, std::cin.peek() != EOF) {
+            /// Parse result for the current frame
+            std::expected<void, PPM::Error> res = read_ppm(std::cin, img);
+
+            if (!res) {
+                std::println("[ERR] {}", res.error().msg);
+                return 1;
+            }
+
+            if (!crc_ok()) { return 1; }
+
+            if (delta) {
+                cache.invert_delta(img, std::cout);
+                continue;
+            }
+
+            run_ops(img, ops, threads, lut);
+            to ? img.out_ppm(std::cout, *to) : img.out_ppm(std::cout);
+        }
+
+        return 0;
+    }
+
+    if (stream) {
+        /// Streamed scanline result
+        std::expected<void, PPM::Error> res =
+            stream_invert(std::cin, std::cout);
+
+        if (!res) {
+            std::println("[ERR] {}", res.error().msg);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    if (!ops.empty() || lut || to || PPM::checksum_enabled() ||
+        PPM::stats_enabled()) {
+        /// PPM image for the transform-chain path
+        std::expected<PPM, PPM::Error> ppm = read_ppm(std::cin);
+
+        if (!ppm) {
+            std::println("[ERR] {}", ppm.error().msg);
+            return 1;
+        }
+
+        if (!crc_ok()) { return 1; }
+
+        run_ops(*ppm, ops, threads, lut);
+        to ? ppm->out_ppm(std::cout, *to) : ppm->out_ppm(std::cout);
+        return 0;
+    }
+
+    /// Single-frame result; 8-bit P6 takes the zero-copy fast path
+    std::expected<void, PPM::Error> res =
+        invert_stream(std::cin, std::cout, threads);
+
+    if (!res) {
+        std::println("[ERR] {}", res.error().msg);
+        return 1;
+    }
 
     return 0;
 }           // main